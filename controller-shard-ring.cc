@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "controller-shard-ring.h"
+#include "ns3/hash.h"
+#include "ns3/assert.h"
+
+#include <sstream>
+
+ControllerShardRing::ControllerShardRing (uint32_t virtualNodes)
+	: m_virtualNodes (virtualNodes)
+{
+	NS_ASSERT (virtualNodes > 0);
+}
+
+uint64_t
+ControllerShardRing::Hash (char kind, uint64_t a, uint64_t b)
+{
+	std::ostringstream oss;
+	oss << kind << a << "-" << b;
+	return ns3::Hash64 (oss.str ());
+}
+
+void
+ControllerShardRing::AddShard (uint32_t shard)
+{
+	for (uint32_t v = 0; v < m_virtualNodes; v++)
+	{
+		m_ring[Hash ('s', shard, v)] = shard;
+	}
+}
+
+uint32_t
+ControllerShardRing::Lookup (uint64_t key) const
+{
+	NS_ASSERT_MSG (!m_ring.empty (), "No controller shard on the ring.");
+
+	// The owner is the first virtual node clockwise from the key, wrapping around the ring.
+	Ring_t::const_iterator it = m_ring.lower_bound (Hash ('k', key, 0));
+	if (it == m_ring.end ())
+	{
+		it = m_ring.begin ();
+	}
+	return it->second;
+}
@@ -0,0 +1,33 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OPENFLOW_CONTROLLER_SHARD_RING_H
+#define OPENFLOW_CONTROLLER_SHARD_RING_H
+
+#include <stdint.h>
+#include <map>
+
+/*
+ * Consistent-hash ring assigning switches to controller shards.
+ * Each shard is placed on the ring several times (virtual nodes) so that the switches
+ * spread evenly, and adding a shard only takes switches over from the others.
+ */
+class ControllerShardRing
+{
+public:
+	ControllerShardRing (uint32_t virtualNodes = 64);
+
+	void AddShard (uint32_t shard);
+
+	// Returns the shard owning the given key (e.g. the node id of a switch).
+	uint32_t Lookup (uint64_t key) const;
+
+private:
+	static uint64_t Hash (char kind, uint64_t a, uint64_t b);
+
+	typedef std::map<uint64_t, uint32_t> Ring_t;
+
+	Ring_t m_ring;
+	uint32_t m_virtualNodes;
+};
+
+#endif /* OPENFLOW_CONTROLLER_SHARD_RING_H */
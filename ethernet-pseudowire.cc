@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ethernet-pseudowire.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/mac48-address.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+NS_LOG_COMPONENT_DEFINE ("EthernetPseudowire");
+NS_OBJECT_ENSURE_REGISTERED (EthernetPseudowire);
+
+namespace {
+
+// PointToPointNetDevice only maps IPv4 and IPv6 to PPP; the relay on the other side accepts anything.
+const uint16_t PSEUDOWIRE_CARRIER_PROTOCOL = 0x0800;
+
+} // anonymous namespace
+
+ns3::TypeId
+EthernetPseudowire::GetTypeId (void)
+{
+	static ns3::TypeId tid = ns3::TypeId ("EthernetPseudowire")
+		.SetParent<ns3::Object> ()
+		.SetGroupName ("OpenFlow")
+		;
+	return tid;
+}
+
+void
+EthernetPseudowire::Install (ns3::Ptr<ns3::Node> relay, ns3::Ptr<ns3::NetDevice> csmaSide, ns3::Ptr<ns3::NetDevice> p2pSide)
+{
+	NS_ASSERT (csmaSide->SupportsSendFrom ());
+
+	ns3::Ptr<EthernetPseudowire> pw = ns3::CreateObject<EthernetPseudowire> ();
+	pw->m_csma = csmaSide;
+	pw->m_p2p = p2pSide;
+
+	relay->RegisterProtocolHandler (ns3::MakeCallback (&EthernetPseudowire::FromCsma, pw), 0, csmaSide, true);
+	relay->RegisterProtocolHandler (ns3::MakeCallback (&EthernetPseudowire::FromP2p, pw), 0, p2pSide, false);
+	relay->AggregateObject (pw);
+}
+
+void
+EthernetPseudowire::DoDispose (void)
+{
+	m_csma = 0;
+	m_p2p = 0;
+	ns3::Object::DoDispose ();
+}
+
+void
+EthernetPseudowire::FromCsma (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> packet, uint16_t protocol,
+	const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType packetType)
+{
+	if (packetType == ns3::NetDevice::PACKET_OTHERHOST || packetType == ns3::NetDevice::PACKET_BROADCAST
+		|| packetType == ns3::NetDevice::PACKET_MULTICAST)
+	{
+		ns3::EthernetHeader header (false);
+		header.SetSource (ns3::Mac48Address::ConvertFrom (from));
+		header.SetDestination (ns3::Mac48Address::ConvertFrom (to));
+		header.SetLengthType (protocol);
+
+		ns3::Ptr<ns3::Packet> frame = packet->Copy ();
+		frame->AddHeader (header);
+		m_p2p->Send (frame, m_p2p->GetBroadcast (), PSEUDOWIRE_CARRIER_PROTOCOL);
+	}
+}
+
+void
+EthernetPseudowire::FromP2p (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> packet, uint16_t protocol,
+	const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType packetType)
+{
+	ns3::Ptr<ns3::Packet> frame = packet->Copy ();
+	ns3::EthernetHeader header (false);
+	frame->RemoveHeader (header);
+
+	NS_LOG_INFO ("Pseudowire " << header.GetSource () << " -> " << header.GetDestination ());
+	m_csma->SendFrom (frame, header.GetSource (), header.GetDestination (), header.GetLengthType ());
+}
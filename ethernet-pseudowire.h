@@ -0,0 +1,40 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OPENFLOW_ETHERNET_PSEUDOWIRE_H
+#define OPENFLOW_ETHERNET_PSEUDOWIRE_H
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+
+/*
+ * Relay carrying whole Ethernet frames over a point-to-point link.
+ * OpenFlow switch ports must support SendFrom, which point-to-point devices don't, while the
+ * distributed simulator only lets point-to-point links cross process boundaries. A cut link
+ * is therefore built as switch -- csma -- relay == p2p == relay -- csma -- switch, and each
+ * relay tunnels every frame it sees on its csma side to the other end unchanged.
+ */
+class EthernetPseudowire : public ns3::Object
+{
+public:
+	static ns3::TypeId GetTypeId (void);
+
+	// Bridges csmaSide and p2pSide, both devices of relay; the pseudowire is aggregated to relay.
+	static void Install (ns3::Ptr<ns3::Node> relay, ns3::Ptr<ns3::NetDevice> csmaSide, ns3::Ptr<ns3::NetDevice> p2pSide);
+
+protected:
+	virtual void DoDispose (void);
+
+private:
+	void FromCsma (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> packet, uint16_t protocol,
+		const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType packetType);
+	void FromP2p (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> packet, uint16_t protocol,
+		const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType packetType);
+
+	ns3::Ptr<ns3::NetDevice> m_csma;
+	ns3::Ptr<ns3::NetDevice> m_p2p;
+};
+
+#endif /* OPENFLOW_ETHERNET_PSEUDOWIRE_H */
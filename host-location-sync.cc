@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "host-location-sync.h"
+#include "openflow-learning-controller.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("HostLocationSync");
+NS_OBJECT_ENSURE_REGISTERED (HostLocationSync);
+
+ns3::TypeId
+HostLocationSync::GetTypeId (void)
+{
+	static ns3::TypeId tid = ns3::TypeId ("HostLocationSync")
+		.SetParent<ns3::Object> ()
+		.SetGroupName ("OpenFlow")
+		.AddConstructor<HostLocationSync> ()
+		.AddAttribute ("Delay",
+			"One-way delay of the synchronization channel between the controller shards.",
+			ns3::TimeValue (ns3::MilliSeconds (1)),
+			ns3::MakeTimeAccessor (&HostLocationSync::m_delay),
+			ns3::MakeTimeChecker ())
+		;
+	return tid;
+}
+
+HostLocationSync::HostLocationSync ()
+	: m_messageCount (0)
+{
+}
+
+void
+HostLocationSync::DoDispose (void)
+{
+	m_shards.clear ();
+	ns3::Object::DoDispose ();
+}
+
+uint32_t
+HostLocationSync::Attach (OpenFlowLearningController* shard)
+{
+	m_shards.push_back (shard);
+	return m_shards.size () - 1;
+}
+
+void
+HostLocationSync::Publish (uint32_t origin, ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port)
+{
+	for (uint32_t i = 0; i < m_shards.size (); i++)
+	{
+		if (i == origin)
+		{
+			continue;
+		}
+
+		m_messageCount++;
+		ns3::Simulator::Schedule (m_delay, &OpenFlowLearningController::ApplyRemoteLocation, m_shards[i], swtch, addr, port);
+	}
+	NS_LOG_INFO ("Shard " << origin << " published addr:" << addr << " to " << m_shards.size () - 1 << " shards");
+}
+
+uint32_t
+HostLocationSync::GetNShards (void) const
+{
+	return m_shards.size ();
+}
+
+uint64_t
+HostLocationSync::GetMessageCount (void) const
+{
+	return m_messageCount;
+}
@@ -0,0 +1,46 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OPENFLOW_HOST_LOCATION_SYNC_H
+#define OPENFLOW_HOST_LOCATION_SYNC_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/mac48-address.h"
+#include "ns3/openflow-switch-net-device.h"
+
+#include <vector>
+
+class OpenFlowLearningController;
+
+/*
+ * Models the east-west channel between the controller shards of one role.
+ * Every new or moved location learned by a shard is delivered to all the other shards after
+ * Delay. It models the sync load only; the receiving shards do not use the locations.
+ */
+class HostLocationSync : public ns3::Object
+{
+public:
+	static ns3::TypeId GetTypeId (void);
+
+	HostLocationSync ();
+
+	// Returns the shard id of the attached controller.
+	uint32_t Attach (OpenFlowLearningController* shard);
+
+	void Publish (uint32_t origin, ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port);
+
+	uint32_t GetNShards (void) const;
+	uint64_t GetMessageCount (void) const;
+
+protected:
+	virtual void DoDispose (void);
+
+private:
+	// Raw pointers: the shards own the channel, not the other way round.
+	std::vector<OpenFlowLearningController*> m_shards;
+
+	ns3::Time m_delay;
+	uint64_t m_messageCount;
+};
+
+#endif /* OPENFLOW_HOST_LOCATION_SYNC_H */
@@ -3,15 +3,11 @@
 #ifndef OPENFLOW_SPECIAL_CONTROLLER_H
 #define OPENFLOW_SPECIAL_CONTROLLER_H
 
-#include "ns3/openflow-interface.h"
+#include "openflow-learning-controller.h"
 
-#include <map>
 #include <vector>
-#include <iostream>
-#include <memory>
-#include <boost/shared_ptr.hpp>
 
-class OpenFlowCoreSwitchController : public ns3::ofi::Controller
+class OpenFlowCoreSwitchController : public OpenFlowLearningController
 {
 public:
 	static ns3::TypeId GetTypeId (void);
@@ -20,17 +16,8 @@ public:
 	
 	std::vector<int> EnumeratePorts (const ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, int port);
 
-	void ReceiveFromSwitch (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer);
-
-private:
-	typedef std::map<ns3::Mac48Address, int> LearnedState;
-	typedef std::map<ns3::Ptr<ns3::OpenFlowSwitchNetDevice>, boost::shared_ptr<LearnedState> > SwitchMap_t;
-
-	LearnedState m_learnedState;
-	SwitchMap_t m_switchMap;
-
 protected:
-	ns3::Time m_expirationTime;
+	void HandlePacketIn (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer);
 };
 
 #endif /* OPENFLOW_SPECIAL_CONTROLLER_H */
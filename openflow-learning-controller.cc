@@ -0,0 +1,696 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "openflow-learning-controller.h"
+#include "host-location-sync.h"
+#include "ns3/openflow-switch-net-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdlib.h>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("OpenFlowLearningController");
+NS_OBJECT_ENSURE_REGISTERED (OpenFlowLearningController);
+
+namespace {
+
+// FNV-1a, folded over the fields of a flow key one at a time.
+uint64_t
+FnvMix (uint64_t hash, const void* data, size_t size)
+{
+	const uint8_t* p = (const uint8_t*) data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+uint64_t
+ReadBe64 (const void* data)
+{
+	const uint8_t* p = (const uint8_t*) data;
+	uint64_t v = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		v = (v << 8) | p[i];
+	}
+	return v;
+}
+
+} // anonymous namespace
+
+ns3::TypeId
+OpenFlowLearningController::GetTypeId (void)
+{
+	static ns3::TypeId tid = ns3::TypeId ("OpenFlowLearningController")
+		.SetParent<ns3::ofi::Controller> ()
+		.SetGroupName ("OpenFlow")
+		.AddAttribute ("ExpirationTime",
+			"Time it takes for learned MAC state entry/created flow to expire.",
+			ns3::TimeValue (ns3::Seconds (0)),
+			ns3::MakeTimeAccessor (&OpenFlowLearningController::m_expirationTime),
+			ns3::MakeTimeChecker ())
+		.AddAttribute ("ControlChannelDelay",
+			"One-way delay of the control channel between a switch and the controller.",
+			ns3::TimeValue (ns3::Seconds (0)),
+			ns3::MakeTimeAccessor (&OpenFlowLearningController::m_controlChannelDelay),
+			ns3::MakeTimeChecker ())
+		.AddAttribute ("ServiceTime",
+			"Time the controller spends on each message (packet-in or stats reply).",
+			ns3::TimeValue (ns3::Seconds (0)),
+			ns3::MakeTimeAccessor (&OpenFlowLearningController::m_serviceTime),
+			ns3::MakeTimeChecker ())
+		.AddAttribute ("BatchOverhead",
+			"Fixed time spent once per batch (dispatch and sending its flow-mods).",
+			ns3::TimeValue (ns3::Seconds (0)),
+			ns3::MakeTimeAccessor (&OpenFlowLearningController::m_batchOverhead),
+			ns3::MakeTimeChecker ())
+		.AddAttribute ("QueueSize",
+			"Maximum number of messages (packet-ins and stats replies) waiting for service; further messages are dropped.",
+			ns3::UintegerValue (1000),
+			ns3::MakeUintegerAccessor (&OpenFlowLearningController::m_queueSize),
+			ns3::MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("BatchSize",
+			"Maximum number of messages (packet-ins and stats replies) served together in one batch.",
+			ns3::UintegerValue (1),
+			ns3::MakeUintegerAccessor (&OpenFlowLearningController::m_batchSize),
+			ns3::MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("FlowTableCapacity",
+			"Number of flow entries a switch can hold (0 for unlimited).",
+			ns3::UintegerValue (0),
+			ns3::MakeUintegerAccessor (&OpenFlowLearningController::m_flowTableCapacity),
+			ns3::MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("EvictionPolicy",
+			"Which entry to delete from a full flow table.",
+			ns3::EnumValue (EVICT_LRU),
+			ns3::MakeEnumAccessor (&OpenFlowLearningController::m_evictionPolicy),
+			ns3::MakeEnumChecker (EVICT_LRU, "Lru",
+				EVICT_LEAST_TRAFFIC, "LeastTraffic"))
+		.AddAttribute ("StatsInterval",
+			"Interval of the flow statistics polls refreshing the shadow tables (0 disables polling).",
+			ns3::TimeValue (ns3::Seconds (1)),
+			ns3::MakeTimeAccessor (&OpenFlowLearningController::m_statsInterval),
+			ns3::MakeTimeChecker ())
+		;
+	return tid;
+}
+
+OpenFlowLearningController::OpenFlowLearningController ()
+	: m_shardId (0),
+	  m_packetInCount (0),
+	  m_flowModCount (0),
+	  m_syncUpdateCount (0),
+	  m_busy (false),
+	  m_dropCount (0),
+	  m_batchCount (0),
+	  m_flowSetupCount (0),
+	  m_pollActivity (false),
+	  m_evictionCount (0),
+	  m_hitCount (0)
+{
+}
+
+void
+OpenFlowLearningController::DoDispose (void)
+{
+	for (std::deque<QueuedMessage>::iterator it = m_queue.begin (); it != m_queue.end (); it++)
+	{
+		ofpbuf_delete (it->buffer);
+	}
+	m_queue.clear ();
+	m_pendingFlowMods.clear ();
+	ns3::Simulator::Cancel (m_pollEvent);
+	m_shadowTables.clear ();
+	m_switchMap.clear ();
+	m_sync = 0;
+	ns3::ofi::Controller::DoDispose ();
+}
+
+void
+OpenFlowLearningController::AddSwitch (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch)
+{
+	ns3::ofi::Controller::AddSwitch (swtch);
+
+	// Switches simulated by another process never talk to this instance of the controller.
+	if (swtch->GetNode ()->GetSystemId () == ns3::Simulator::GetSystemId ())
+	{
+		m_shadowTables[swtch];
+	}
+}
+
+void
+OpenFlowLearningController::ReceiveFromSwitch (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer)
+{
+	if (m_switches.find (swtch) == m_switches.end ())
+	{
+		NS_LOG_ERROR ("Can't receive from this switch, not registered to the Controller.");
+		return;
+	}
+
+	// We have received any packet at this point, so we pull the header to figure out what type of packet we're handling.
+	uint8_t type = ns3::ofi::Controller::GetPacketType (buffer);
+
+	if (type == OFPT_PACKET_IN) // The switch didn't understand the packet it received, so it forwarded it to the controller.
+	{
+		m_packetInCount++;
+
+		// Table misses are traffic too; keep the shadow tables fresh while they happen.
+		m_pollActivity = true;
+		if (!m_statsInterval.IsZero () && !m_pollEvent.IsRunning ())
+		{
+			m_pollEvent = ns3::Simulator::Schedule (m_statsInterval, &OpenFlowLearningController::PollFlowStats, this);
+		}
+
+		// The switch reuses its buffer, so keep our own copy while the packet-in travels and waits.
+		ns3::Simulator::Schedule (m_controlChannelDelay, &OpenFlowLearningController::EnqueueMessage, this,
+			swtch, ofpbuf_clone (buffer), type, ns3::Simulator::Now ());
+	}
+	else if (type == OFPT_STATS_REPLY)
+	{
+		ns3::Simulator::Schedule (m_controlChannelDelay, &OpenFlowLearningController::EnqueueMessage, this,
+			swtch, ofpbuf_clone (buffer), type, ns3::Simulator::Now ());
+	}
+}
+
+void
+OpenFlowLearningController::EnqueueMessage (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer, uint8_t type, ns3::Time sent)
+{
+	if (m_queue.size () >= m_queueSize)
+	{
+		NS_LOG_INFO ("Controller queue full (" << m_queue.size () << "), dropping message type " << (int) type << " from swtch:" << swtch);
+		if (type == OFPT_PACKET_IN)
+		{
+			m_dropCount++;
+		}
+		ofpbuf_delete (buffer);
+		return;
+	}
+
+	QueuedMessage item;
+	item.swtch = swtch;
+	item.buffer = buffer;
+	item.type = type;
+	item.sent = sent;
+	m_queue.push_back (item);
+
+	if (!m_busy)
+	{
+		StartService ();
+	}
+}
+
+void
+OpenFlowLearningController::StartService (void)
+{
+	NS_ASSERT (!m_queue.empty ());
+	m_busy = true;
+
+	std::vector<QueuedMessage> batch;
+	while (!m_queue.empty () && batch.size () < m_batchSize)
+	{
+		batch.push_back (m_queue.front ());
+		m_queue.pop_front ();
+	}
+	m_batchCount++;
+
+	ns3::Time duration = m_batchOverhead + ns3::Time (m_serviceTime.GetTimeStep () * (int64_t) batch.size ());
+	ns3::Simulator::Schedule (duration, &OpenFlowLearningController::FinishService, this, batch);
+}
+
+void
+OpenFlowLearningController::FinishService (std::vector<QueuedMessage> batch)
+{
+	ns3::Time arrival = ns3::Simulator::Now () + m_controlChannelDelay;
+
+	for (unsigned i = 0; i < batch.size (); i++)
+	{
+		if (batch[i].type == OFPT_STATS_REPLY)
+		{
+			HandleFlowStats (batch[i].swtch, batch[i].buffer);
+			ofpbuf_delete (batch[i].buffer);
+			continue;
+		}
+
+		HandlePacketIn (batch[i].swtch, batch[i].buffer);
+		ofpbuf_delete (batch[i].buffer);
+
+		ns3::Time latency = arrival - batch[i].sent;
+		m_flowSetupCount++;
+		m_flowSetupLatencySum += latency;
+		if (latency > m_flowSetupLatencyMax)
+		{
+			m_flowSetupLatencyMax = latency;
+		}
+	}
+
+	// Everything the batch produced goes out in one go.
+	if (!m_pendingFlowMods.empty ())
+	{
+		ns3::Simulator::Schedule (m_controlChannelDelay, &OpenFlowLearningController::DeliverFlowMods, this, m_pendingFlowMods);
+		m_pendingFlowMods.clear ();
+	}
+
+	if (m_queue.empty ())
+	{
+		m_busy = false;
+	}
+	else
+	{
+		StartService ();
+	}
+}
+
+void
+OpenFlowLearningController::DeliverFlowMods (std::vector<QueuedFlowMod> flowMods)
+{
+	for (unsigned i = 0; i < flowMods.size (); i++)
+	{
+		ns3::ofi::Controller::SendToSwitch (flowMods[i].swtch, flowMods[i].ofm, flowMods[i].ofm->header.length);
+	}
+}
+
+void
+OpenFlowLearningController::SetHostLocationSync (ns3::Ptr<HostLocationSync> sync)
+{
+	m_sync = sync;
+	m_shardId = sync->Attach (this);
+}
+
+void
+OpenFlowLearningController::ApplyRemoteLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port)
+{
+	// Nothing reads these: a switch stays with the shard it was assigned to, so only the
+	// overhead of keeping the shards in sync is modelled.
+	m_syncUpdateCount++;
+	NS_LOG_INFO ("Shard " << m_shardId << " got from sync that swtch:" << swtch << ", addr:" << addr << " can be found over port " << port);
+}
+
+uint32_t
+OpenFlowLearningController::GetNSwitches (uint32_t systemId) const
+{
+	uint32_t n = 0;
+	for (Switches_t::const_iterator it = m_switches.begin (); it != m_switches.end (); it++)
+	{
+		if ((*it)->GetNode ()->GetSystemId () == systemId)
+		{
+			n++;
+		}
+	}
+	return n;
+}
+
+uint64_t
+OpenFlowLearningController::GetPacketInCount (void) const
+{
+	return m_packetInCount;
+}
+
+uint64_t
+OpenFlowLearningController::GetFlowModCount (void) const
+{
+	return m_flowModCount;
+}
+
+uint64_t
+OpenFlowLearningController::GetSyncUpdateCount (void) const
+{
+	return m_syncUpdateCount;
+}
+
+uint64_t
+OpenFlowLearningController::GetPacketInDropCount (void) const
+{
+	return m_dropCount;
+}
+
+uint64_t
+OpenFlowLearningController::GetBatchCount (void) const
+{
+	return m_batchCount;
+}
+
+ns3::Time
+OpenFlowLearningController::GetMeanFlowSetupLatency (void) const
+{
+	if (m_flowSetupCount == 0)
+	{
+		return ns3::Seconds (0);
+	}
+	return ns3::Time (m_flowSetupLatencySum.GetTimeStep () / (int64_t) m_flowSetupCount);
+}
+
+ns3::Time
+OpenFlowLearningController::GetMaxFlowSetupLatency (void) const
+{
+	return m_flowSetupLatencyMax;
+}
+
+bool
+OpenFlowLearningController::LookupLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int& port)
+{
+	SwitchMap_t::iterator smitr = m_switchMap.find (swtch);
+	if (smitr == m_switchMap.end ())
+	{
+		return false;
+	}
+
+	boost::shared_ptr<LearnedState> learnedState = smitr->second;
+	LearnedState::iterator lsitr = learnedState->find (addr);
+	if (lsitr == learnedState->end ())
+	{
+		return false;
+	}
+
+	port = lsitr->second;
+	return true;
+}
+
+void
+OpenFlowLearningController::LearnLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port)
+{
+	SwitchMap_t::iterator smitr = m_switchMap.find (swtch);
+	if (smitr == m_switchMap.end ()) // We haven't learned our source MAC Address yet.
+	{
+		smitr = m_switchMap.insert (std::make_pair (swtch, boost::shared_ptr<LearnedState> (new LearnedState ()))).first;
+	}
+	assert (smitr != m_switchMap.end ());
+
+	LearnedState::iterator lsitr = smitr->second->find (addr);
+	if (lsitr != smitr->second->end () && lsitr->second == port)
+	{
+		return; // Nothing new to tell the other shards.
+	}
+	(*smitr->second)[addr] = port;
+	NS_LOG_INFO ("Learned that swtch:" << swtch << ", addr:" << addr << " can be found over port " << port);
+
+	if (m_sync != 0)
+	{
+		m_sync->Publish (m_shardId, swtch, addr, port);
+	}
+}
+
+void
+OpenFlowLearningController::SendFlowMod (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofp_flow_mod* ofm)
+{
+	m_flowModCount++;
+	TrackFlow (swtch, ofm);
+
+	// Held back until the current batch is done, see FinishService.
+	QueuedFlowMod item;
+	item.swtch = swtch;
+	item.ofm = ofm;
+	m_pendingFlowMods.push_back (item);
+}
+
+uint32_t
+OpenFlowLearningController::GetFlowTableCapacity (void) const
+{
+	return m_flowTableCapacity;
+}
+
+uint64_t
+OpenFlowLearningController::GetFlowTableEvictionCount (void) const
+{
+	return m_evictionCount;
+}
+
+uint64_t
+OpenFlowLearningController::GetFlowTableHitCount (void) const
+{
+	return m_hitCount;
+}
+
+uint32_t
+OpenFlowLearningController::GetFlowTablePeakOccupancy (void) const
+{
+	uint32_t peak = 0;
+	for (ShadowTableMap_t::const_iterator it = m_shadowTables.begin (); it != m_shadowTables.end (); it++)
+	{
+		peak = std::max (peak, it->second.peak);
+	}
+	return peak;
+}
+
+double
+OpenFlowLearningController::GetTableMissRate (void) const
+{
+	uint64_t lookups = m_packetInCount + m_hitCount;
+	return lookups == 0 ? 0.0 : (double) m_packetInCount / lookups;
+}
+
+uint64_t
+OpenFlowLearningController::Fingerprint (const sw_flow_key& key)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	hash = FnvMix (hash, &key.wildcards, sizeof(key.wildcards));
+	hash = FnvMix (hash, &key.flow.in_port, sizeof(key.flow.in_port));
+	hash = FnvMix (hash, &key.flow.dl_vlan, sizeof(key.flow.dl_vlan));
+	hash = FnvMix (hash, &key.flow.dl_type, sizeof(key.flow.dl_type));
+	hash = FnvMix (hash, key.flow.dl_src, sizeof(key.flow.dl_src));
+	hash = FnvMix (hash, key.flow.dl_dst, sizeof(key.flow.dl_dst));
+	hash = FnvMix (hash, &key.flow.nw_src, sizeof(key.flow.nw_src));
+	hash = FnvMix (hash, &key.flow.nw_dst, sizeof(key.flow.nw_dst));
+	hash = FnvMix (hash, &key.flow.nw_proto, sizeof(key.flow.nw_proto));
+	hash = FnvMix (hash, &key.flow.tp_src, sizeof(key.flow.tp_src));
+	hash = FnvMix (hash, &key.flow.tp_dst, sizeof(key.flow.tp_dst));
+	return hash;
+}
+
+void
+OpenFlowLearningController::TrackFlow (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, const ofp_flow_mod* ofm)
+{
+	if (ntohs (ofm->command) != OFPFC_ADD)
+	{
+		return;
+	}
+
+	ShadowTableMap_t::iterator it = m_shadowTables.find (swtch);
+	if (it == m_shadowTables.end ())
+	{
+		return;
+	}
+	ShadowTable& table = it->second;
+
+	sw_flow_key key;
+	flow_extract_match (&key, &ofm->match);
+	uint64_t fingerprint = Fingerprint (key);
+
+	// The entry exists on the switch once the flow-mod got there, and until its hard timeout.
+	int64_t installed = (ns3::Simulator::Now () + m_controlChannelDelay).GetTimeStep ();
+	uint16_t hardTimeout = ntohs (ofm->hard_timeout);
+	int64_t expires = hardTimeout == OFP_FLOW_PERMANENT ? std::numeric_limits<int64_t>::max ()
+		: installed + ns3::Seconds (hardTimeout).GetTimeStep ();
+
+	// A flow-mod carrying a buffer id makes the switch run the buffered packet through the new entry.
+	bool buffered = ofm->buffer_id != htonl (0xffffffff);
+
+	// Entries the switch has timed out by then no longer take room there.
+	for (uint32_t i = 0; i < table.entries.size (); )
+	{
+		if (table.entries[i].expires <= installed)
+		{
+			RemoveShadowEntry (table, i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	boost::unordered_map<uint64_t, uint32_t>::iterator idx = table.index.find (fingerprint);
+	if (idx != table.index.end ())
+	{
+		// Adding an existing flow replaces it, counters and timeout included.
+		table.entries[idx->second].lastHit = installed;
+		table.entries[idx->second].expires = expires;
+		table.entries[idx->second].packetCount = 0;
+		table.entries[idx->second].bufferedPacket = buffered;
+		return;
+	}
+
+	if (m_flowTableCapacity != 0 && table.entries.size () >= m_flowTableCapacity)
+	{
+		EvictFlow (swtch, table);
+	}
+
+	ShadowEntry entry;
+	entry.fingerprint = fingerprint;
+	entry.lastHit = installed;
+	entry.expires = expires;
+	entry.packetCount = 0;
+	entry.bufferedPacket = buffered;
+
+	table.entries.push_back (entry);
+	table.keys.push_back (key);
+	table.index[fingerprint] = table.entries.size () - 1;
+	table.peak = std::max (table.peak, (uint32_t) table.entries.size ());
+}
+
+void
+OpenFlowLearningController::EvictFlow (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ShadowTable& table)
+{
+	NS_ASSERT (!table.entries.empty ());
+
+	uint32_t victim = 0;
+	for (uint32_t i = 1; i < table.entries.size (); i++)
+	{
+		const ShadowEntry& e = table.entries[i];
+		const ShadowEntry& v = table.entries[victim];
+
+		bool better;
+		if (m_evictionPolicy == EVICT_LRU)
+		{
+			better = e.lastHit < v.lastHit;
+		}
+		else
+		{
+			better = e.packetCount < v.packetCount || (e.packetCount == v.packetCount && e.lastHit < v.lastHit);
+		}
+
+		if (better)
+		{
+			victim = i;
+		}
+	}
+
+	NS_LOG_INFO ("Flow table of swtch:" << swtch << " full (" << table.entries.size () << "), evicting entry with "
+		<< table.entries[victim].packetCount << " packets");
+
+	// Goes out ahead of the flow-mod that needs the room, in the same batch.
+	QueuedFlowMod item;
+	item.swtch = swtch;
+	item.ofm = ns3::ofi::Controller::BuildFlow (table.keys[victim], -1, OFPFC_DELETE_STRICT, 0, 0, 0, 0);
+	item.ofm->out_port = htons (OFPP_NONE); // BuildFlow leaves it unset, and the switch filters deletes by it
+	m_pendingFlowMods.push_back (item);
+
+	RemoveShadowEntry (table, victim);
+	m_evictionCount++;
+}
+
+void
+OpenFlowLearningController::RemoveShadowEntry (ShadowTable& table, uint32_t i)
+{
+	uint32_t last = table.entries.size () - 1;
+
+	table.index.erase (table.entries[i].fingerprint);
+	if (i != last)
+	{
+		table.entries[i] = table.entries[last];
+		table.keys[i] = table.keys[last];
+		table.index[table.entries[i].fingerprint] = i;
+	}
+	table.entries.pop_back ();
+	table.keys.pop_back ();
+}
+
+void
+OpenFlowLearningController::PollFlowStats (void)
+{
+	// Stop polling once the network has gone quiet; the next packet-in or hit restarts it.
+	bool active = m_pollActivity;
+	m_pollActivity = false;
+
+	for (ShadowTableMap_t::iterator it = m_shadowTables.begin (); it != m_shadowTables.end (); it++)
+	{
+		ns3::Simulator::Schedule (m_controlChannelDelay, &OpenFlowLearningController::SendFlowStatsRequest, this, it->first);
+	}
+
+	if (active)
+	{
+		m_pollEvent = ns3::Simulator::Schedule (m_statsInterval, &OpenFlowLearningController::PollFlowStats, this);
+	}
+}
+
+void
+OpenFlowLearningController::SendFlowStatsRequest (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch)
+{
+	size_t size = sizeof(ofp_stats_request) + sizeof(ofp_flow_stats_request);
+
+	ofp_stats_request* osr = (ofp_stats_request*) malloc (size);
+	memset (osr, 0, size);
+	osr->header.version = OFP_VERSION;
+	osr->header.type = OFPT_STATS_REQUEST;
+	osr->header.length = htons (size);
+	osr->type = htons (OFPST_FLOW);
+
+	// All flows of all tables, whatever port they output to.
+	ofp_flow_stats_request* ofsr = (ofp_flow_stats_request*) osr->body;
+	ofsr->match.wildcards = htonl (OFPFW_ALL);
+	ofsr->table_id = 0xff;
+	ofsr->out_port = htons (OFPP_NONE);
+
+	ns3::ofi::Controller::SendToSwitch (swtch, osr, size);
+}
+
+void
+OpenFlowLearningController::HandleFlowStats (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer)
+{
+	ShadowTableMap_t::iterator it = m_shadowTables.find (swtch);
+	if (it == m_shadowTables.end () || buffer->size < sizeof(ofp_stats_reply))
+	{
+		return;
+	}
+
+	ofp_stats_reply* osr = (ofp_stats_reply*) buffer->data;
+	if (ntohs (osr->type) != OFPST_FLOW)
+	{
+		return;
+	}
+
+	ShadowTable& table = it->second;
+	int64_t now = ns3::Simulator::Now ().GetTimeStep ();
+
+	size_t offset = offsetof (ofp_stats_reply, body);
+	while (offset + sizeof(ofp_flow_stats) <= buffer->size)
+	{
+		ofp_flow_stats* ofs = (ofp_flow_stats*) ((uint8_t*) buffer->data + offset);
+		uint16_t length = ntohs (ofs->length);
+		if (length < sizeof(ofp_flow_stats))
+		{
+			break;
+		}
+		offset += length;
+
+		sw_flow_key key;
+		flow_extract_match (&key, &ofs->match);
+		boost::unordered_map<uint64_t, uint32_t>::iterator idx = table.index.find (Fingerprint (key));
+		if (idx == table.index.end ())
+		{
+			continue;
+		}
+
+		ShadowEntry& entry = table.entries[idx->second];
+		uint64_t packetCount = ReadBe64 (&ofs->packet_count);
+		if (packetCount <= entry.packetCount)
+		{
+			continue;
+		}
+
+		uint64_t hits = packetCount - entry.packetCount;
+		entry.packetCount = packetCount;
+		if (entry.bufferedPacket)
+		{
+			// That one already counted as a miss when it came up as a packet-in.
+			entry.bufferedPacket = false;
+			hits--;
+		}
+
+		if (hits > 0)
+		{
+			m_hitCount += hits;
+			entry.lastHit = now;
+			m_pollActivity = true;
+			if (!m_statsInterval.IsZero () && !m_pollEvent.IsRunning ())
+			{
+				m_pollEvent = ns3::Simulator::Schedule (m_statsInterval, &OpenFlowLearningController::PollFlowStats, this);
+			}
+		}
+	}
+}
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OPENFLOW_LEARNING_CONTROLLER_H
+#define OPENFLOW_LEARNING_CONTROLLER_H
+
+#include "ns3/openflow-interface.h"
+#include "ns3/event-id.h"
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <iostream>
+#include <memory>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+class HostLocationSync;
+
+/*
+ * Common part of the MAC learning controllers.
+ * Keeps the learned (switch, address) -> port state, counts the control-plane load of this
+ * controller instance and, when several instances (shards) serve the same role, publishes every
+ * new or moved host location to the other shards through a HostLocationSync channel. Switches
+ * are never handed over between shards, so the replicas are not stored: the channel only
+ * models the east-west sync traffic a replicated deployment would carry.
+ *
+ * Packet-ins and stats replies reach the controller after ControlChannelDelay and wait in a
+ * bounded queue (QueueSize) for a single server. The server takes up to BatchSize messages at a
+ * time and spends BatchOverhead once plus ServiceTime per message on them; the flow-mods
+ * produced by a batch are then sent together, so the overhead is amortized over the batch.
+ *
+ * Every flow installed on a switch is also recorded, with its hard timeout, in a shadow table
+ * for that switch, whose hit timestamps and packet counts are refreshed by polling the switch's
+ * flow statistics every StatsInterval; the requests take ControlChannelDelay to reach the switch
+ * and the replies are served like packet-ins, so polling loads the controller. When a switch
+ * still holds FlowTableCapacity unexpired entries, the entry chosen by EvictionPolicy is deleted
+ * before the new one is added. Only the switches simulated by this process are tracked.
+ */
+class OpenFlowLearningController : public ns3::ofi::Controller
+{
+public:
+	enum EvictionPolicy
+	{
+		EVICT_LRU,
+		EVICT_LEAST_TRAFFIC
+	};
+
+	static ns3::TypeId GetTypeId (void);
+
+	OpenFlowLearningController ();
+
+	void AddSwitch (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch);
+
+	void ReceiveFromSwitch (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer);
+
+	// Joins the sync channel shared by the shards of the same role.
+	void SetHostLocationSync (ns3::Ptr<HostLocationSync> sync);
+
+	// Called by the sync channel when another shard has learned a host location; only counted.
+	void ApplyRemoteLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port);
+
+	// Switches of this controller simulated by the given process (0 when not distributed).
+	uint32_t GetNSwitches (uint32_t systemId) const;
+	uint64_t GetPacketInCount (void) const;
+	uint64_t GetFlowModCount (void) const;
+	uint64_t GetSyncUpdateCount (void) const;
+	uint64_t GetPacketInDropCount (void) const;
+	uint64_t GetBatchCount (void) const;
+
+	// Time from the switch emitting a packet-in to the resulting flow-mods reaching it.
+	ns3::Time GetMeanFlowSetupLatency (void) const;
+	ns3::Time GetMaxFlowSetupLatency (void) const;
+
+	uint32_t GetFlowTableCapacity (void) const;
+	uint64_t GetFlowTableEvictionCount (void) const;
+	// Packets that matched a tracked entry, as seen by the flow statistics.
+	uint64_t GetFlowTableHitCount (void) const;
+	// Largest number of entries any of this controller's switches has held.
+	uint32_t GetFlowTablePeakOccupancy (void) const;
+	// Packet-ins over all packets the switches have looked up.
+	double GetTableMissRate (void) const;
+
+protected:
+	virtual void DoDispose (void);
+
+	// Handles an OFPT_PACKET_IN; the buffer still starts with the ofp_packet_in header.
+	virtual void HandlePacketIn (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer) = 0;
+
+	bool LookupLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int& port);
+	void LearnLocation (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ns3::Mac48Address addr, int port);
+
+	void SendFlowMod (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofp_flow_mod* ofm);
+
+	typedef std::map<ns3::Mac48Address, int> LearnedState;
+	typedef std::map<ns3::Ptr<ns3::OpenFlowSwitchNetDevice>, boost::shared_ptr<LearnedState> > SwitchMap_t;
+
+	SwitchMap_t m_switchMap;
+
+	ns3::Time m_expirationTime;
+
+private:
+	struct QueuedMessage
+	{
+		ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch;
+		ofpbuf* buffer;
+		uint8_t type; // OFPT_PACKET_IN or OFPT_STATS_REPLY
+		ns3::Time sent;
+	};
+
+	struct QueuedFlowMod
+	{
+		ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch;
+		ofp_flow_mod* ofm;
+	};
+
+	// Hot part of a shadow entry, all that lookups and victim selection touch.
+	struct ShadowEntry
+	{
+		uint64_t fingerprint;
+		int64_t lastHit; // in time steps
+		int64_t expires; // hard timeout, in time steps
+		uint64_t packetCount;
+		bool bufferedPacket; // packet_count still includes the packet-in released by the flow-mod
+	};
+
+	// Entries are kept in contiguous arrays (hot entries, cold match keys at the same index)
+	// and found by a 64-bit fingerprint of the match; removal swaps with the last entry.
+	struct ShadowTable
+	{
+		std::vector<ShadowEntry> entries;
+		std::vector<sw_flow_key> keys;
+		boost::unordered_map<uint64_t, uint32_t> index;
+		uint32_t peak;
+
+		ShadowTable () : peak (0) {}
+	};
+
+	typedef std::map<ns3::Ptr<ns3::OpenFlowSwitchNetDevice>, ShadowTable> ShadowTableMap_t;
+
+	static uint64_t Fingerprint (const sw_flow_key& key);
+
+	void TrackFlow (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, const ofp_flow_mod* ofm);
+	void EvictFlow (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ShadowTable& table);
+	void RemoveShadowEntry (ShadowTable& table, uint32_t i);
+
+	void PollFlowStats (void);
+	void SendFlowStatsRequest (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch);
+	void HandleFlowStats (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer);
+
+	void EnqueueMessage (ns3::Ptr<ns3::OpenFlowSwitchNetDevice> swtch, ofpbuf* buffer, uint8_t type, ns3::Time sent);
+	void StartService (void);
+	void FinishService (std::vector<QueuedMessage> batch);
+	void DeliverFlowMods (std::vector<QueuedFlowMod> flowMods);
+
+	ns3::Ptr<HostLocationSync> m_sync;
+	uint32_t m_shardId;
+
+	uint64_t m_packetInCount;
+	uint64_t m_flowModCount;
+	uint64_t m_syncUpdateCount;
+
+	ns3::Time m_controlChannelDelay;
+	ns3::Time m_serviceTime;
+	ns3::Time m_batchOverhead;
+	uint32_t m_queueSize;
+	uint32_t m_batchSize;
+
+	std::deque<QueuedMessage> m_queue;
+	std::vector<QueuedFlowMod> m_pendingFlowMods;
+	bool m_busy;
+
+	uint64_t m_dropCount;
+	uint64_t m_batchCount;
+	uint64_t m_flowSetupCount;
+	ns3::Time m_flowSetupLatencySum;
+	ns3::Time m_flowSetupLatencyMax;
+
+	uint32_t m_flowTableCapacity;
+	EvictionPolicy m_evictionPolicy;
+	ns3::Time m_statsInterval;
+
+	ShadowTableMap_t m_shadowTables;
+	ns3::EventId m_pollEvent;
+	bool m_pollActivity;
+
+	uint64_t m_evictionCount;
+	uint64_t m_hitCount;
+};
+
+#endif /* OPENFLOW_LEARNING_CONTROLLER_H */
@@ -0,0 +1,341 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "pcap-replay-application.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+namespace {
+
+const uint32_t PCAP_MAGIC_USEC = 0xa1b2c3d4;
+const uint32_t PCAP_MAGIC_NSEC = 0xa1b23c4d;
+const uint32_t PCAP_LINKTYPE_ETHERNET = 1;
+
+const uint64_t PCAP_FILE_HEADER_SIZE = 24;
+const uint64_t PCAP_RECORD_HEADER_SIZE = 16;
+
+const uint32_t ETHERNET_HEADER_SIZE = 14;
+const uint32_t VLAN_TAG_SIZE = 4;
+const uint16_t ETHERTYPE_VLAN = 0x8100;
+
+uint32_t
+ByteSwap32 (uint32_t v)
+{
+	return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+}
+
+} // anonymous namespace
+
+ns3::TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+	static ns3::TypeId tid = ns3::TypeId ("PcapReplayApplication")
+		.SetParent<ns3::Application> ()
+		.SetGroupName ("OpenFlow")
+		.AddConstructor<PcapReplayApplication> ()
+		.AddAttribute ("File",
+			"The pcap file (Ethernet link type) to replay.",
+			ns3::StringValue (""),
+			ns3::MakeStringAccessor (&PcapReplayApplication::m_fileName),
+			ns3::MakeStringChecker ())
+		.AddAttribute ("DeviceIndex",
+			"Index of the NetDevice of the node the frames are sent through.",
+			ns3::UintegerValue (0),
+			ns3::MakeUintegerAccessor (&PcapReplayApplication::m_deviceIndex),
+			ns3::MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("Remote",
+			"Destination MAC address of the replayed frames.",
+			ns3::Mac48AddressValue (ns3::Mac48Address::GetBroadcast ()),
+			ns3::MakeMac48AddressAccessor (&PcapReplayApplication::m_remote),
+			ns3::MakeMac48AddressChecker ())
+		.AddAttribute ("Speed",
+			"Replay speed relative to the capture timing (2.0 replays twice as fast).",
+			ns3::DoubleValue (1.0),
+			ns3::MakeDoubleAccessor (&PcapReplayApplication::m_speed),
+			ns3::MakeDoubleChecker<double> (1e-9))
+		.AddAttribute ("MaxFrames",
+			"Stop after this many frames of this instance (0 for the whole capture).",
+			ns3::UintegerValue (0),
+			ns3::MakeUintegerAccessor (&PcapReplayApplication::m_maxFrames),
+			ns3::MakeUintegerChecker<uint64_t> ())
+		.AddAttribute ("Stride",
+			"Number of instances sharing the capture.",
+			ns3::UintegerValue (1),
+			ns3::MakeUintegerAccessor (&PcapReplayApplication::m_stride),
+			ns3::MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("Offset",
+			"Which frames of the stride this instance sends.",
+			ns3::UintegerValue (0),
+			ns3::MakeUintegerAccessor (&PcapReplayApplication::m_strideOffset),
+			ns3::MakeUintegerChecker<uint32_t> ())
+		.AddAttribute ("WindowSize",
+			"Bytes of the mapping read before the pages behind the read position are released.",
+			ns3::UintegerValue (64 << 20),
+			ns3::MakeUintegerAccessor (&PcapReplayApplication::m_windowSize),
+			ns3::MakeUintegerChecker<uint64_t> (1))
+		.AddTraceSource ("Tx",
+			"A frame of the capture has been sent.",
+			ns3::MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace),
+			"ns3::Packet::TracedCallback")
+		;
+	return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+	: m_fd (-1),
+	  m_map (0),
+	  m_mapSize (0),
+	  m_offset (0),
+	  m_released (0),
+	  m_frameIndex (0),
+	  m_swapped (false),
+	  m_nanosecond (false),
+	  m_firstTimestamp (0),
+	  m_sentCount (0),
+	  m_skippedCount (0)
+{
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+	Unmap ();
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+	Unmap ();
+	m_device = 0;
+	ns3::Application::DoDispose ();
+}
+
+uint64_t
+PcapReplayApplication::GetSentCount (void) const
+{
+	return m_sentCount;
+}
+
+uint64_t
+PcapReplayApplication::GetSkippedCount (void) const
+{
+	return m_skippedCount;
+}
+
+void
+PcapReplayApplication::StartApplication (void)
+{
+	NS_ASSERT_MSG (m_strideOffset < m_stride, "Offset must be smaller than Stride.");
+
+	m_device = GetNode ()->GetDevice (m_deviceIndex);
+	m_startTime = ns3::Simulator::Now ();
+
+	Map ();
+	if (NextFrame ())
+	{
+		ScheduleFrame ();
+	}
+}
+
+void
+PcapReplayApplication::StopApplication (void)
+{
+	ns3::Simulator::Cancel (m_sendEvent);
+	NS_LOG_INFO ("Replay of " << m_fileName << " stopped: sent " << m_sentCount << ", skipped " << m_skippedCount);
+	Unmap ();
+}
+
+void
+PcapReplayApplication::Map (void)
+{
+	m_fd = open (m_fileName.c_str (), O_RDONLY);
+	if (m_fd < 0)
+	{
+		NS_FATAL_ERROR ("Can't open pcap file " << m_fileName);
+	}
+
+	struct stat st;
+	if (fstat (m_fd, &st) != 0 || (uint64_t) st.st_size < PCAP_FILE_HEADER_SIZE)
+	{
+		NS_FATAL_ERROR ("Not a pcap file: " << m_fileName);
+	}
+	m_mapSize = st.st_size;
+
+	void* map = mmap (0, m_mapSize, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if (map == MAP_FAILED)
+	{
+		NS_FATAL_ERROR ("Can't map pcap file " << m_fileName);
+	}
+	m_map = (const uint8_t*) map;
+
+	// Read-ahead suits the front-to-back walk; the pages behind us are released in SendFrame.
+	madvise (map, m_mapSize, MADV_SEQUENTIAL);
+
+	uint32_t magic;
+	memcpy (&magic, m_map, sizeof(magic));
+	m_swapped = (magic == ByteSwap32 (PCAP_MAGIC_USEC) || magic == ByteSwap32 (PCAP_MAGIC_NSEC));
+	magic = m_swapped ? ByteSwap32 (magic) : magic;
+	if (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC)
+	{
+		NS_FATAL_ERROR ("Not a pcap file: " << m_fileName);
+	}
+	m_nanosecond = (magic == PCAP_MAGIC_NSEC);
+
+	if (Read32 (m_map + 20) != PCAP_LINKTYPE_ETHERNET)
+	{
+		NS_FATAL_ERROR ("Only Ethernet captures can be replayed: " << m_fileName);
+	}
+
+	m_offset = PCAP_FILE_HEADER_SIZE;
+	m_released = 0;
+	m_frameIndex = 0;
+
+	// Every instance times its frames from the first record of the capture, whatever its share
+	// of the stride, so instances started together replay on one common time base.
+	m_firstTimestamp = (m_mapSize >= PCAP_FILE_HEADER_SIZE + PCAP_RECORD_HEADER_SIZE) ? FrameTimestamp () : 0;
+
+	NS_LOG_INFO ("Mapped " << m_fileName << " (" << m_mapSize << " bytes)");
+}
+
+void
+PcapReplayApplication::Unmap (void)
+{
+	if (m_map != 0)
+	{
+		munmap ((void*) m_map, m_mapSize);
+		m_map = 0;
+	}
+	if (m_fd >= 0)
+	{
+		close (m_fd);
+		m_fd = -1;
+	}
+}
+
+uint32_t
+PcapReplayApplication::Read32 (const uint8_t* p) const
+{
+	uint32_t v;
+	memcpy (&v, p, sizeof(v));
+	return m_swapped ? ByteSwap32 (v) : v;
+}
+
+bool
+PcapReplayApplication::NextFrame (void)
+{
+	while (m_offset + PCAP_RECORD_HEADER_SIZE <= m_mapSize)
+	{
+		uint32_t length = Read32 (m_map + m_offset + 8);
+		if (m_offset + PCAP_RECORD_HEADER_SIZE + length > m_mapSize)
+		{
+			NS_LOG_WARN ("Truncated frame at offset " << m_offset << " of " << m_fileName);
+			return false;
+		}
+
+		if (m_frameIndex % m_stride == m_strideOffset)
+		{
+			return true;
+		}
+
+		m_offset += PCAP_RECORD_HEADER_SIZE + length;
+		m_frameIndex++;
+	}
+	return false;
+}
+
+int64_t
+PcapReplayApplication::FrameTimestamp (void) const
+{
+	const uint8_t* record = m_map + m_offset;
+	int64_t sec = Read32 (record);
+	int64_t frac = Read32 (record + 4);
+	return sec * 1000000000 + (m_nanosecond ? frac : frac * 1000);
+}
+
+void
+PcapReplayApplication::ScheduleFrame (void)
+{
+	int64_t timestamp = FrameTimestamp ();
+
+	// Relative to the first frame of the capture, so rounding does not accumulate over a long capture.
+	ns3::Time at = m_startTime + ns3::NanoSeconds ((int64_t) ((timestamp - m_firstTimestamp) / m_speed));
+	ns3::Time delay = at > ns3::Simulator::Now () ? at - ns3::Simulator::Now () : ns3::Seconds (0);
+	m_sendEvent = ns3::Simulator::Schedule (delay, &PcapReplayApplication::SendFrame, this);
+}
+
+void
+PcapReplayApplication::SendFrame (void)
+{
+	const uint8_t* record = m_map + m_offset;
+	uint32_t length = Read32 (record + 8);
+	const uint8_t* frame = record + PCAP_RECORD_HEADER_SIZE;
+
+	uint32_t header = ETHERNET_HEADER_SIZE;
+	uint16_t etherType = length >= ETHERNET_HEADER_SIZE ? (frame[12] << 8) | frame[13] : 0;
+	if (etherType == ETHERTYPE_VLAN && length >= ETHERNET_HEADER_SIZE + VLAN_TAG_SIZE)
+	{
+		etherType = (frame[16] << 8) | frame[17];
+		header += VLAN_TAG_SIZE;
+	}
+
+	// 802.3 length fields (< 0x0600) carry no protocol we could hand to the device.
+	bool sent = false;
+	if (etherType >= 0x0600)
+	{
+		ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet> (frame + header, length - header);
+		sent = m_device->Send (packet, m_remote, etherType);
+		if (sent)
+		{
+			m_txTrace (packet);
+		}
+	}
+
+	if (sent)
+	{
+		m_sentCount++;
+	}
+	else
+	{
+		NS_LOG_INFO ("Skipped frame " << m_frameIndex << " of " << m_fileName << " (" << length << " bytes, type " << etherType << ")");
+		m_skippedCount++;
+	}
+
+	m_offset += PCAP_RECORD_HEADER_SIZE + length;
+	m_frameIndex++;
+
+	// Give the pages we are done with back, keeping the resident part of the mapping bounded.
+	if (m_offset - m_released >= m_windowSize)
+	{
+		uint64_t pageSize = sysconf (_SC_PAGESIZE);
+		uint64_t end = (m_offset / pageSize) * pageSize;
+		madvise ((void*) (m_map + m_released), end - m_released, MADV_DONTNEED);
+		m_released = end;
+	}
+
+	if (m_maxFrames != 0 && m_sentCount + m_skippedCount >= m_maxFrames)
+	{
+		NS_LOG_INFO ("Replay of " << m_fileName << " reached MaxFrames");
+		return;
+	}
+
+	if (NextFrame ())
+	{
+		ScheduleFrame ();
+	}
+	else
+	{
+		NS_LOG_INFO ("Replay of " << m_fileName << " done: sent " << m_sentCount << ", skipped " << m_skippedCount);
+	}
+}
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef OPENFLOW_PCAP_REPLAY_APPLICATION_H
+#define OPENFLOW_PCAP_REPLAY_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/traced-callback.h"
+
+#include <string>
+#include <stdint.h>
+
+/*
+ * Replays the Ethernet frames of a pcap file through one NetDevice of its node.
+ * The file is memory-mapped and walked in place; pages behind the read position are
+ * released every WindowSize bytes, so a multi-GB capture is replayed with bounded memory.
+ * The Ethernet header of each frame is replaced by the device's own (source = device,
+ * destination = Remote), the EtherType and payload are kept. Frames are sent at their
+ * original relative time divided by Speed.
+ * Several instances can share one capture: each one sends the frames whose index modulo
+ * Stride equals Offset.
+ */
+class PcapReplayApplication : public ns3::Application
+{
+public:
+	static ns3::TypeId GetTypeId (void);
+
+	PcapReplayApplication ();
+	virtual ~PcapReplayApplication ();
+
+	uint64_t GetSentCount (void) const;
+	uint64_t GetSkippedCount (void) const;
+
+protected:
+	virtual void DoDispose (void);
+
+private:
+	virtual void StartApplication (void);
+	virtual void StopApplication (void);
+
+	// Aborts the simulation when the file can't be mapped or is not an Ethernet capture.
+	void Map (void);
+	void Unmap (void);
+
+	// Moves m_offset to the next frame of this instance; false at the end of the capture.
+	bool NextFrame (void);
+	int64_t FrameTimestamp (void) const;
+	uint32_t Read32 (const uint8_t* p) const;
+
+	void ScheduleFrame (void);
+	void SendFrame (void);
+
+	std::string m_fileName;
+	uint32_t m_deviceIndex;
+	ns3::Mac48Address m_remote;
+	double m_speed;
+	uint64_t m_maxFrames;
+	uint32_t m_stride;
+	uint32_t m_strideOffset;
+	uint64_t m_windowSize;
+
+	ns3::Ptr<ns3::NetDevice> m_device;
+
+	int m_fd;
+	const uint8_t* m_map;
+	uint64_t m_mapSize;
+	uint64_t m_offset;
+	uint64_t m_released;
+	uint64_t m_frameIndex;
+
+	bool m_swapped;
+	bool m_nanosecond;
+	int64_t m_firstTimestamp;
+	ns3::Time m_startTime;
+
+	uint64_t m_sentCount;
+	uint64_t m_skippedCount;
+	ns3::EventId m_sendEvent;
+
+	ns3::TracedCallback<ns3::Ptr<const ns3::Packet> > m_txTrace;
+};
+
+#endif /* OPENFLOW_PCAP_REPLAY_APPLICATION_H */
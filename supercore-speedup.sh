@@ -0,0 +1,26 @@
+#!/bin/sh
+#
+# Runs supercore-test on the pod-partitioned topology once sequentially and once over
+# local MPI processes, and lets the distributed run report its speedup.
+# Run from the top of the ns-3 tree (configured with --enable-mpi):
+#
+#   supercore-speedup.sh [processes] [supercore-test arguments...]
+#
+# PROGRAM (default supercore-test), WAF (default ./waf) and MPIEXEC (default mpiexec)
+# can be overridden from the environment.
+
+PROCESSES=${1:-4}
+[ $# -gt 0 ] && shift
+
+PROGRAM=${PROGRAM:-supercore-test}
+WAF=${WAF:-./waf}
+MPIEXEC=${MPIEXEC:-mpiexec}
+
+SEQUENTIAL_MS=$($WAF --run "$PROGRAM --partitionPods $*" | sed -n 's/.*wallclock-ms=\([0-9]*\).*/\1/p')
+if [ -z "$SEQUENTIAL_MS" ]; then
+	echo "sequential run of $PROGRAM did not report its wall-clock time" >&2
+	exit 1
+fi
+echo "sequential wallclock-ms=$SEQUENTIAL_MS"
+
+$WAF --command-template="$MPIEXEC -np $PROCESSES %s --mpi --sequentialMs=$SEQUENTIAL_MS $*" --run "$PROGRAM"
@@ -5,6 +5,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -12,16 +15,26 @@
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/openflow-module.h"
+#include "ns3/point-to-point-module.h"
 #include "ns3/log.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 
 #include "openflow-basic-controller.h"
 #include "openflow-core-switch-controller.h"
+#include "host-location-sync.h"
+#include "controller-shard-ring.h"
 #include "ips-imitation.h"
+#include "pcap-replay-application.h"
+#include "ethernet-pseudowire.h"
 
 NS_LOG_COMPONENT_DEFINE ("SuperCoreTest");
 
 bool verbose = false;
 ns3::Time timeout = ns3::Seconds (0);
+uint32_t systemId = 0;
+uint32_t systemCount = 1;
 
 bool
 SetVerbose (std::string value)
@@ -41,22 +54,165 @@ SetTimeout (std::string value)
 	return false;
 }
 
+// Pod (0-3) of switches 3-14, i.e. the subtree under aggregation switch 3-6; -1 for switches 0-2.
+int
+SwitchPod (int i)
+{
+	if (i >= 3 && i <= 6)
+	{
+		return i - 3;
+	}
+	if (i >= 7)
+	{
+		return (i - 7) / 2;
+	}
+	return -1;
+}
+
+int
+TerminalPod (int i)
+{
+	return i / 4;
+}
+
+// Switches 0-2 stay with process 0, the pods are dealt out over all processes.
+uint32_t
+PodSystemId (int pod)
+{
+	return pod < 0 ? 0 : pod % systemCount;
+}
+
+// In a distributed run every process builds the whole topology but only simulates its own nodes.
+bool
+IsLocal (ns3::Ptr<ns3::Node> node)
+{
+	return node->GetSystemId () == systemId;
+}
+
+// Prints the per-shard control-plane load of one controller role.
+template <class T>
+void
+ReportShardLoad (std::string role, const std::vector<ns3::Ptr<T> > &shards, ns3::Ptr<HostLocationSync> sync)
+{
+	uint64_t total = 0;
+	uint64_t busiest = 0;
+
+	for (unsigned i = 0; i < shards.size (); i++)
+	{
+		std::cout << role << " shard " << i
+			<< ": switches=" << shards[i]->GetNSwitches (systemId)
+			<< " packet-ins=" << shards[i]->GetPacketInCount ()
+			<< " flow-mods=" << shards[i]->GetFlowModCount ()
+			<< " sync-updates=" << shards[i]->GetSyncUpdateCount ()
+			<< " drops=" << shards[i]->GetPacketInDropCount ()
+			<< " batches=" << shards[i]->GetBatchCount ()
+			<< " setup-latency-mean=" << shards[i]->GetMeanFlowSetupLatency ().GetSeconds () << "s"
+			<< " setup-latency-max=" << shards[i]->GetMaxFlowSetupLatency ().GetSeconds () << "s"
+			<< std::endl;
+
+		std::cout << role << " shard " << i
+			<< ": table-capacity=" << shards[i]->GetFlowTableCapacity ()
+			<< " table-peak=" << shards[i]->GetFlowTablePeakOccupancy ()
+			<< " hits=" << shards[i]->GetFlowTableHitCount ()
+			<< " evictions=" << shards[i]->GetFlowTableEvictionCount ()
+			<< " miss-rate=" << shards[i]->GetTableMissRate ()
+			<< std::endl;
+
+		total += shards[i]->GetPacketInCount ();
+		busiest = std::max (busiest, shards[i]->GetPacketInCount ());
+	}
+
+	// With perfect balance the busiest shard carries total/N; the ratio is the capacity gained by sharding.
+	std::cout << role << ": shards=" << shards.size ()
+		<< " packet-ins=" << total
+		<< " busiest-shard=" << busiest
+		<< " scale-out=" << (busiest == 0 ? 1.0 : (double) total / busiest)
+		<< " sync-messages=" << sync->GetMessageCount ()
+		<< std::endl;
+}
+
 int
 main (int argc, char *argv[])
 {
+	uint32_t n_basicShards = 1;
+	uint32_t n_coreShards = 1;
+	ns3::Time syncDelay = ns3::MilliSeconds (1);
+	ns3::Time controlDelay = ns3::Seconds (0);
+	ns3::Time serviceTime = ns3::Seconds (0);
+	ns3::Time batchOverhead = ns3::Seconds (0);
+	uint32_t queueSize = 1000;
+	uint32_t batchSize = 1;
+	std::string pcapFile = "";
+	std::string pcapSources = "8";
+	uint32_t pcapDestination = 5;
+	double pcapSpeed = 1.0;
+	bool partitionPods = false;
+	bool distributed = false;
+	double sequentialMs = 0;
+	uint32_t flowTableCapacity = 0;
+	std::string evictionPolicy = "Lru";
+	ns3::Time statsInterval = ns3::Seconds (1);
+
 	ns3::CommandLine cmd;
 	cmd.AddValue ("verbose", "Verbose (turns on logging).", ns3::MakeCallback (&SetVerbose));
 	cmd.AddValue ("timeout", "Expiration Timeout.", ns3::MakeCallback (&SetTimeout));
+	cmd.AddValue ("basicShards", "Number of OpenFlowBasicController instances (edge and core-tier switches).", n_basicShards);
+	cmd.AddValue ("coreShards", "Number of OpenFlowCoreSwitchController instances (aggregation switches).", n_coreShards);
+	cmd.AddValue ("syncDelay", "Delay of the host location sync channel between shards.", syncDelay);
+	cmd.AddValue ("controlDelay", "One-way delay of the switch-controller control channel.", controlDelay);
+	cmd.AddValue ("serviceTime", "Controller service time per message (packet-in or stats reply).", serviceTime);
+	cmd.AddValue ("batchOverhead", "Controller fixed cost per batch of messages.", batchOverhead);
+	cmd.AddValue ("queueSize", "Controller queue capacity, in messages (packet-ins and stats replies).", queueSize);
+	cmd.AddValue ("batchSize", "Maximum number of messages (packet-ins and stats replies) the controller serves per batch.", batchSize);
+	cmd.AddValue ("pcap", "Replay this pcap file into the topology in addition to the On-Off flows.", pcapFile);
+	cmd.AddValue ("pcapSources", "Comma-separated terminals the capture is replayed from (frames are split between them).", pcapSources);
+	cmd.AddValue ("pcapDestination", "Terminal the replayed frames are addressed to.", pcapDestination);
+	cmd.AddValue ("pcapSpeed", "Replay speed relative to the capture timing.", pcapSpeed);
+	cmd.AddValue ("partitionPods", "Cut the links between switches 1-2 and 3-6 with pseudowires so every pod can run in its own process.", partitionPods);
+	cmd.AddValue ("mpi", "Run the pods distributed over the MPI processes (implies partitionPods).", distributed);
+	cmd.AddValue ("flowTableCapacity", "Flow entries each switch can hold (0 for unlimited).", flowTableCapacity);
+	cmd.AddValue ("evictionPolicy", "Entry evicted from a full flow table: Lru or LeastTraffic.", evictionPolicy);
+	cmd.AddValue ("statsInterval", "Interval of the controllers' flow statistics polls.", statsInterval);
+	cmd.AddValue ("sequentialMs", "Wall-clock time of the sequential --partitionPods run, to report the speedup (supercore-speedup.sh fills it in).", sequentialMs);
 
 	cmd.Parse (argc, argv);
 
+	if (distributed)
+	{
+#ifdef NS3_MPI
+		partitionPods = true;
+		ns3::GlobalValue::Bind ("SimulatorImplementationType", ns3::StringValue ("ns3::DistributedSimulatorImpl"));
+		ns3::MpiInterface::Enable (&argc, &argv);
+		systemId = ns3::MpiInterface::GetSystemId ();
+		systemCount = ns3::MpiInterface::GetSize ();
+#else
+		NS_FATAL_ERROR ("--mpi needs ns-3 configured with --enable-mpi.");
+#endif
+	}
+
+	NS_ABORT_MSG_IF (n_basicShards == 0 || n_coreShards == 0, "Every controller role needs at least one shard.");
+
+	// Applies to every shard of both learning controllers.
+	ns3::Config::SetDefault ("OpenFlowLearningController::ControlChannelDelay", ns3::TimeValue (controlDelay));
+	ns3::Config::SetDefault ("OpenFlowLearningController::ServiceTime", ns3::TimeValue (serviceTime));
+	ns3::Config::SetDefault ("OpenFlowLearningController::BatchOverhead", ns3::TimeValue (batchOverhead));
+	ns3::Config::SetDefault ("OpenFlowLearningController::QueueSize", ns3::UintegerValue (queueSize));
+	ns3::Config::SetDefault ("OpenFlowLearningController::BatchSize", ns3::UintegerValue (batchSize));
+	ns3::Config::SetDefault ("OpenFlowLearningController::FlowTableCapacity", ns3::UintegerValue (flowTableCapacity));
+	ns3::Config::SetDefault ("OpenFlowLearningController::EvictionPolicy", ns3::StringValue (evictionPolicy));
+	ns3::Config::SetDefault ("OpenFlowLearningController::StatsInterval", ns3::TimeValue (statsInterval));
+
 	if (verbose)
 	{
 		ns3::LogComponentEnable ("OpenFlowInterface", ns3::LOG_LEVEL_INFO);
 		ns3::LogComponentEnable ("OpenFlowSwitchNetDevice", ns3::LOG_LEVEL_INFO);
 		ns3::LogComponentEnable ("OpenFlowBasicController", ns3::LOG_LEVEL_INFO);
 		ns3::LogComponentEnable ("OpenFlowCoreSwitchController", ns3::LOG_LEVEL_INFO);
+		ns3::LogComponentEnable ("OpenFlowLearningController", ns3::LOG_LEVEL_INFO);
+		ns3::LogComponentEnable ("HostLocationSync", ns3::LOG_LEVEL_INFO);
 		ns3::LogComponentEnable ("IpsImitation", ns3::LOG_LEVEL_INFO);
+		ns3::LogComponentEnable ("PcapReplayApplication", ns3::LOG_LEVEL_INFO);
+		ns3::LogComponentEnable ("EthernetPseudowire", ns3::LOG_LEVEL_INFO);
 		ns3::LogComponentEnable ("SuperCoreTest", ns3::LOG_LEVEL_INFO);
 	}
 
@@ -65,16 +221,33 @@ main (int argc, char *argv[])
 
 	NS_LOG_INFO ("Create Nodes.");
 	ns3::NodeContainer terminals;
-	terminals.Create (n_terminals);
+	for (int i = 0; i < n_terminals; i++)
+	{
+		terminals.Create (1, PodSystemId (TerminalPod (i)));
+	}
 
 	ns3::NodeContainer csmaSwitch;
-	csmaSwitch.Create (n_switches);
+	for (int i = 0; i < n_switches; i++)
+	{
+		csmaSwitch.Create (1, PodSystemId (SwitchPod (i)));
+	}
 
 	NS_LOG_INFO ("Build Topology.");
 	ns3::CsmaHelper csma;
 	csma.SetChannelAttribute ("DataRate", ns3::DataRateValue (5000000));
 	csma.SetChannelAttribute ("Delay", ns3::TimeValue (ns3::MilliSeconds (2)));
 
+	// A pseudowire keeps the 5Mb/s and 2ms of the link it replaces on its point-to-point hop,
+	// which is also the lookahead between the processes; its csma ends add next to nothing.
+	ns3::CsmaHelper pseudowireCsma;
+	pseudowireCsma.SetChannelAttribute ("DataRate", ns3::DataRateValue (ns3::DataRate ("100Gbps")));
+	pseudowireCsma.SetChannelAttribute ("Delay", ns3::TimeValue (ns3::Seconds (0)));
+
+	ns3::PointToPointHelper pointToPoint;
+	pointToPoint.SetDeviceAttribute ("DataRate", ns3::DataRateValue (5000000));
+	pointToPoint.SetDeviceAttribute ("Mtu", ns3::UintegerValue (1500 + 14)); // room for the tunneled Ethernet header
+	pointToPoint.SetChannelAttribute ("Delay", ns3::TimeValue (ns3::MilliSeconds (2)));
+
 	// Create the csma links, from each terminal to the switch.
 	ns3::NetDeviceContainer terminalDevices;
 	ns3::NetDeviceContainer switchDevices[n_switches];
@@ -94,9 +267,28 @@ NS_LOG_INFO("81:");
 	{
 		for (int j = 1; j <= 2; j++)
 		{
-			ns3::NetDeviceContainer link = csma.Install (ns3::NodeContainer (csmaSwitch.Get (j), csmaSwitch.Get (i)));
-			switchDevices[j].Add (link.Get (0));
-			switchDevices[i].Add (link.Get (1));
+			if (!partitionPods)
+			{
+				ns3::NetDeviceContainer link = csma.Install (ns3::NodeContainer (csmaSwitch.Get (j), csmaSwitch.Get (i)));
+				switchDevices[j].Add (link.Get (0));
+				switchDevices[i].Add (link.Get (1));
+				continue;
+			}
+
+			// [switch j] -- [relay] == p2p == [relay] -- [switch i]
+			ns3::NodeContainer relays;
+			relays.Create (1, PodSystemId (SwitchPod (j)));
+			relays.Create (1, PodSystemId (SwitchPod (i)));
+
+			ns3::NetDeviceContainer upper = pseudowireCsma.Install (ns3::NodeContainer (csmaSwitch.Get (j), relays.Get (0)));
+			ns3::NetDeviceContainer wire = pointToPoint.Install (relays.Get (0), relays.Get (1));
+			ns3::NetDeviceContainer lower = pseudowireCsma.Install (ns3::NodeContainer (relays.Get (1), csmaSwitch.Get (i)));
+
+			EthernetPseudowire::Install (relays.Get (0), upper.Get (1), wire.Get (0));
+			EthernetPseudowire::Install (relays.Get (1), lower.Get (0), wire.Get (1));
+
+			switchDevices[j].Add (upper.Get (0));
+			switchDevices[i].Add (lower.Get (1));
 		}
 	}
 
@@ -139,33 +331,65 @@ NS_LOG_INFO("128:");
 
 	// controller create
 	ns3::Ptr<IpsImitation> ipsImitation = ns3::CreateObject<IpsImitation> ();
-	ns3::Ptr<OpenFlowBasicController> openFlowBasicController = ns3::CreateObject<OpenFlowBasicController> ();
-	ns3::Ptr<OpenFlowCoreSwitchController> openFlowCoreSwitchController = ns3::CreateObject<OpenFlowCoreSwitchController> ();
+
+	std::vector<ns3::Ptr<OpenFlowBasicController> > openFlowBasicControllers;
+	std::vector<ns3::Ptr<OpenFlowCoreSwitchController> > openFlowCoreSwitchControllers;
+	ControllerShardRing basicRing;
+	ControllerShardRing coreRing;
+
+	// The shards of one role share what they learn over their own sync channel.
+	ns3::Ptr<HostLocationSync> basicSync = ns3::CreateObject<HostLocationSync> ();
+	ns3::Ptr<HostLocationSync> coreSync = ns3::CreateObject<HostLocationSync> ();
+	basicSync->SetAttribute ("Delay", ns3::TimeValue (syncDelay));
+	coreSync->SetAttribute ("Delay", ns3::TimeValue (syncDelay));
+
+	for (uint32_t i = 0; i < n_basicShards; i++)
+	{
+		openFlowBasicControllers.push_back (ns3::CreateObject<OpenFlowBasicController> ());
+		openFlowBasicControllers[i]->SetHostLocationSync (basicSync);
+		basicRing.AddShard (i);
+	}
+
+	for (uint32_t i = 0; i < n_coreShards; i++)
+	{
+		openFlowCoreSwitchControllers.push_back (ns3::CreateObject<OpenFlowCoreSwitchController> ());
+		openFlowCoreSwitchControllers[i]->SetHostLocationSync (coreSync);
+		coreRing.AddShard (i);
+	}
 
 	if (!timeout.IsZero ())
 	{
-		openFlowBasicController->SetAttribute ("ExpirationTime", ns3::TimeValue (timeout));
-		openFlowCoreSwitchController->SetAttribute ("ExpirationTime", ns3::TimeValue (timeout));
+		for (uint32_t i = 0; i < n_basicShards; i++)
+		{
+			openFlowBasicControllers[i]->SetAttribute ("ExpirationTime", ns3::TimeValue (timeout));
+		}
+		for (uint32_t i = 0; i < n_coreShards; i++)
+		{
+			openFlowCoreSwitchControllers[i]->SetAttribute ("ExpirationTime", ns3::TimeValue (timeout));
+		}
 	}
 	
 	// [ips imitation (switch 0)] -- [ipsImitation]
 	openFlowSwitchHelper.Install (switchNode[0], switchDevices[0], ipsImitation);
 
-	// [switch 1-2, 7-14] -- [openFlowBasicController]
-	for (int i = 1; i <= 2; i++)
-	{
-		openFlowSwitchHelper.Install (switchNode[i], switchDevices[i], openFlowBasicController);
-	}
-
-	for (int i = 7; i < n_switches; i++)
+	// [switch 1-2, 7-14] -- [openFlowBasicController shard chosen by the ring]
+	for (int i = 1; i < n_switches; i++)
 	{
-		openFlowSwitchHelper.Install (switchNode[i], switchDevices[i], openFlowBasicController);
+		if (i >= 3 && i <= 6)
+		{
+			continue;
+		}
+		uint32_t shard = basicRing.Lookup (switchNode[i]->GetId ());
+		NS_LOG_INFO ("switch " << i << " -> OpenFlowBasicController shard " << shard);
+		openFlowSwitchHelper.Install (switchNode[i], switchDevices[i], openFlowBasicControllers[shard]);
 	}
 
-	// [switch 3-6] -- [openFlowCoreSwitchController]
+	// [switch 3-6] -- [openFlowCoreSwitchController shard chosen by the ring]
 	for (int i = 3; i <= 6; i++)
 	{
-		openFlowSwitchHelper.Install (switchNode[i], switchDevices[i], openFlowCoreSwitchController);
+		uint32_t shard = coreRing.Lookup (switchNode[i]->GetId ());
+		NS_LOG_INFO ("switch " << i << " -> OpenFlowCoreSwitchController shard " << shard);
+		openFlowSwitchHelper.Install (switchNode[i], switchDevices[i], openFlowCoreSwitchControllers[shard]);
 	}
 
 	ns3::Ptr<ns3::NetDevice> p_NetDevice;
@@ -202,16 +426,23 @@ NS_LOG_INFO("128:");
 	ns3::OnOffHelper onoff ("ns3::TcpSocketFactory", ns3::Address (ns3::InetSocketAddress (ns3::Ipv4Address ("10.1.1.6"), port)));
 	onoff.SetConstantRate (ns3::DataRate ("500kb/s"));
 
-	ns3::ApplicationContainer app = onoff.Install (terminals.Get (8));
+	ns3::ApplicationContainer app;
+	if (IsLocal (terminals.Get (8)))
+	{
+		app = onoff.Install (terminals.Get (8));
 
-	// Start the application
-	app.Start (ns3::Seconds (1.0));
-	app.Stop (ns3::Seconds (10.0));
+		// Start the application
+		app.Start (ns3::Seconds (1.0));
+		app.Stop (ns3::Seconds (10.0));
+	}
 
 	// Create ana optional packet sink to receive these packets
 	ns3::PacketSinkHelper sink ("ns3::TcpSocketFactory", ns3::Address (ns3::InetSocketAddress (ns3::Ipv4Address::GetAny(), port)));
-	app = sink.Install (terminals.Get (5));
-	app.Start (ns3::Seconds (0.0));
+	if (IsLocal (terminals.Get (5)))
+	{
+		app = sink.Install (terminals.Get (5));
+		app.Start (ns3::Seconds (0.0));
+	}
 
 	//
 	// Create a similar flow from n3 to n2, starting at time 1.1 seconds
@@ -219,13 +450,59 @@ NS_LOG_INFO("128:");
 	ns3::OnOffHelper onoff2 ("ns3::TcpSocketFactory", ns3::Address (ns3::InetSocketAddress (ns3::Ipv4Address ("10.1.1.11"), port)));
 	onoff2.SetConstantRate (ns3::DataRate ("500kb/s"));
 
-	app = onoff2.Install (terminals.Get (8));
-	app.Start (ns3::Seconds (2.0));
-	app.Stop (ns3::Seconds (10.0));
+	if (IsLocal (terminals.Get (8)))
+	{
+		app = onoff2.Install (terminals.Get (8));
+		app.Start (ns3::Seconds (2.0));
+		app.Stop (ns3::Seconds (10.0));
+	}
 
 	// Create ana optional packet sink to receive these packets
-	app = sink.Install (terminals.Get (10));
-	app.Start (ns3::Seconds (0.0));
+	if (IsLocal (terminals.Get (10)))
+	{
+		app = sink.Install (terminals.Get (10));
+		app.Start (ns3::Seconds (0.0));
+	}
+
+	// Replay a real capture, split over the source terminals.
+	std::vector<ns3::Ptr<PcapReplayApplication> > replays;
+	if (!pcapFile.empty ())
+	{
+		std::vector<int> sources;
+		std::istringstream iss (pcapSources);
+		std::string token;
+		while (std::getline (iss, token, ','))
+		{
+			std::istringstream field (token);
+			int source = -1;
+			field >> source;
+			NS_ABORT_MSG_IF (field.fail () || !field.eof () || source < 0 || source >= n_terminals,
+				"--pcapSources: '" << token << "' is not a terminal index (0-" << n_terminals - 1 << ").");
+			sources.push_back (source);
+		}
+		NS_ABORT_MSG_IF (sources.empty (), "--pcapSources names no terminal.");
+		NS_ABORT_MSG_IF (pcapDestination >= (uint32_t) n_terminals,
+			"--pcapDestination must be a terminal index (0-" << n_terminals - 1 << ").");
+
+		ns3::Mac48Address remote = ns3::Mac48Address::ConvertFrom (terminalDevices.Get (pcapDestination)->GetAddress ());
+		for (unsigned k = 0; k < sources.size (); k++)
+		{
+			if (!IsLocal (terminals.Get (sources[k])))
+			{
+				continue;
+			}
+
+			ns3::Ptr<PcapReplayApplication> replay = ns3::CreateObject<PcapReplayApplication> ();
+			replay->SetAttribute ("File", ns3::StringValue (pcapFile));
+			replay->SetAttribute ("Remote", ns3::Mac48AddressValue (remote));
+			replay->SetAttribute ("Speed", ns3::DoubleValue (pcapSpeed));
+			replay->SetAttribute ("Stride", ns3::UintegerValue (sources.size ()));
+			replay->SetAttribute ("Offset", ns3::UintegerValue (k));
+			terminals.Get (sources[k])->AddApplication (replay);
+			replay->SetStartTime (ns3::Seconds (1.0));
+			replays.push_back (replay);
+		}
+	}
 
 	NS_LOG_INFO ("Configure Tracing.");
 
@@ -234,20 +511,82 @@ NS_LOG_INFO("128:");
 	// Trace output will be sent to the file "openflow-switch.tr"
 	//
 	ns3::AsciiTraceHelper ascii;
-	csma.EnableAsciiAll (ascii.CreateFileStream ("supercore.tr"));
+	ns3::NodeContainer localNodes;
+	if (distributed)
+	{
+		// Each process traces its own nodes only, otherwise they would overwrite each other's files.
+		ns3::NodeContainer allNodes = ns3::NodeContainer::GetGlobal ();
+		for (unsigned i = 0; i < allNodes.GetN (); i++)
+		{
+			if (IsLocal (allNodes.Get (i)))
+			{
+				localNodes.Add (allNodes.Get (i));
+			}
+		}
+
+		std::ostringstream traceName;
+		traceName << "supercore-rank" << systemId << ".tr";
+		csma.EnableAscii (ascii.CreateFileStream (traceName.str ()), localNodes);
+	}
+	else
+	{
+		csma.EnableAsciiAll (ascii.CreateFileStream ("supercore.tr"));
+	}
 
 	//
 	// Also configure some tcpdump traces; each interface will be traced.
 	// The output files will be named: openflow-vlan-switch-<nodeId>-<interfaceId>.pcap
 	// and can be read by the "tcpdump -r" command (use "-tt" option to display timestamps correctly)
 	//
-	csma.EnablePcapAll ("supercore", false);
+	if (distributed)
+	{
+		csma.EnablePcap ("supercore", localNodes, false);
+	}
+	else
+	{
+		csma.EnablePcapAll ("supercore", false);
+	}
 
 	//
 	// Now, do the actual simulation.
 	//
 	NS_LOG_INFO ("Run Simulation.");
+	ns3::SystemWallClockMs wallClock;
+	wallClock.Start ();
 	ns3::Simulator::Run ();
+	int64_t elapsedMs = wallClock.End ();
+
+	// Controller state is partitioned with the switches: a process only feeds its own switches.
+	std::ostringstream rank;
+	if (distributed)
+	{
+		rank << "rank " << systemId << " ";
+	}
+	ReportShardLoad (rank.str () + "OpenFlowBasicController", openFlowBasicControllers, basicSync);
+	ReportShardLoad (rank.str () + "OpenFlowCoreSwitchController", openFlowCoreSwitchControllers, coreSync);
+
+	if (systemId == 0)
+	{
+		std::cout << "processes=" << systemCount << " wallclock-ms=" << elapsedMs;
+		if (sequentialMs > 0)
+		{
+			std::cout << " speedup=" << sequentialMs / std::max (elapsedMs, (int64_t) 1);
+		}
+		std::cout << std::endl;
+	}
+
+	for (unsigned k = 0; k < replays.size (); k++)
+	{
+		std::cout << "pcap replay " << k << ": sent=" << replays[k]->GetSentCount ()
+			<< " skipped=" << replays[k]->GetSkippedCount () << std::endl;
+	}
+
 	ns3::Simulator::Destroy ();
+#ifdef NS3_MPI
+	if (distributed)
+	{
+		ns3::MpiInterface::Disable ();
+	}
+#endif
 	NS_LOG_INFO ("Done.");
 }